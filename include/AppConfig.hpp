@@ -8,10 +8,16 @@ class AppConfig {
 public:
     bool load(const std::string& filename);
     
+    // Parses "key=value" entries separated by newlines, ';' or ','.
+    // Returns false if no entry could be parsed.
+    bool load_string(const std::string& text);
+    
     float get(const std::string& key, float default_val) const;
     
     std::optional<float> get(const std::string& key) const;
 
 private:
     std::map<std::string, float> params_;
+    
+    bool parse_line(std::string line);
 };
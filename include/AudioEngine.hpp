@@ -1,12 +1,17 @@
 #pragma once
 
 #include <jack/jack.h>
+#include <chrono>
 #include <memory>
 #include <vector>
 #include "AppConfig.hpp"
 #include "Ducker.hpp"
 #include "VoiceIndoorFilter.hpp"
 #include "LadspaLoader.hpp"
+#include "NoiseGate.hpp"
+#include "QualityGovernor.hpp"
+#include "SignalMeter.hpp"
+#include "TraceRecorder.hpp"
 
 class AudioEngine {
 public:
@@ -19,35 +24,66 @@ public:
     AudioEngine(AudioEngine&&) = delete;
     AudioEngine& operator=(AudioEngine&&) = delete;
     
+    // Opens its own JACK client (standalone executable)
     bool initialize();
     
+    // Runs on a client owned by jackd (in-process client); the client is
+    // deactivated but not closed on destruction
+    bool initialize(jack_client_t* client);
+    
     bool is_active() const { return client_ != nullptr; }
+    
+    // Housekeeping for the non-realtime thread (logs governor tier changes,
+    // writes pending trace dumps)
+    void poll();
+    
+    // Async-signal-safe; the trace is written by the next poll()
+    void request_trace_dump();
+    
+    bool is_tracing() const { return trace_ != nullptr; }
 
 private:
     // JACK callbacks
     static int static_process_callback(jack_nframes_t nframes, void* arg);
     static int static_bufsize_callback(jack_nframes_t nframes, void* arg);
+    static int static_xrun_callback(void* arg);
     
     int process(jack_nframes_t nframes);
     int on_buffer_size_change(jack_nframes_t nframes);
+    int on_xrun();
     
     // Initialization helpers
     bool create_jack_client();
+    bool setup_client();
     void register_jack_ports();
     void initialize_processors(float sample_rate);
     bool load_ladspa_plugin(float sample_rate);
+    void initialize_governor(float sample_rate);
+    void initialize_meter();
+    void initialize_trace();
+    void write_trace_dump();
     
     // Processing
     void process_input_filters(jack_nframes_t nframes, float* in_l, float* in_r);
     void process_ladspa(jack_nframes_t nframes);
+    void render_tier(QualityGovernor::Tier tier, jack_nframes_t nframes,
+                     float*& dst_l, float*& dst_r);
+    void apply_tier();
+    bool is_fading() const;
     void process_output_mix(jack_nframes_t nframes, float* sec_l, float* sec_r, 
                            float* out_l, float* out_r);
+    void process_fused(jack_nframes_t nframes, QualityGovernor::Tier tier,
+                       float* in_l, float* in_r, float* sec_l, float* sec_r,
+                       float* out_l, float* out_r);
+    void update_meter(jack_nframes_t nframes, float* in_l, float* in_r,
+                      float* sec_l, float* sec_r, float* out_l, float* out_r);
     
     // Configuration
     const AppConfig& config_;
     
     // JACK resources
     jack_client_t* client_ = nullptr;
+    bool owns_client_ = true;
     jack_port_t* in_l_ = nullptr;
     jack_port_t* in_r_ = nullptr;
     jack_port_t* out_l_ = nullptr;
@@ -61,10 +97,39 @@ private:
     std::unique_ptr<Ducker> ducker_l_;
     std::unique_ptr<Ducker> ducker_r_;
     std::unique_ptr<LadspaLoader> ladspa_loader_;
+    std::unique_ptr<NoiseGate> gate_l_;
+    std::unique_ptr<NoiseGate> gate_r_;
+    
+    // Quality governor (only active when the LADSPA plugin is loaded)
+    std::unique_ptr<QualityGovernor> governor_;
+    QualityGovernor::Tier active_tier_ = QualityGovernor::Tier::Full;
+    QualityGovernor::Tier fade_from_ = QualityGovernor::Tier::Full;
+    jack_nframes_t fade_pos_ = 0;
+    jack_nframes_t fade_len_ = 0;
+    jack_nframes_t preroll_len_ = 0;
+    jack_nframes_t fade_preroll_ = 0;
+    
+    // LADSPA control indices and values swapped by the governor
+    static constexpr size_t CONTROL_MAX_ERB = 2;
+    static constexpr size_t CONTROL_MAX_DF = 3;
+    float max_erb_ = 0.0f;
+    float max_df_ = 0.0f;
+    float reduced_max_erb_ = 0.0f;
+    float reduced_max_df_ = 0.0f;
+    
+    // Metering published through shared memory
+    std::unique_ptr<SignalMeter> meter_;
+    float mic_envelope_ = 0.0f;
+    
+    // Opt-in per-stage timeline tracing
+    std::unique_ptr<TraceRecorder> trace_;
+    std::chrono::steady_clock::time_point last_trace_dump_{};
     
     // Audio buffers
     std::vector<float> buf_in_l_;
     std::vector<float> buf_in_r_;
     std::vector<float> buf_out_l_;
     std::vector<float> buf_out_r_;
+    std::vector<float> buf_fade_l_;
+    std::vector<float> buf_fade_r_;
 };
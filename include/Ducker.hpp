@@ -21,6 +21,8 @@ public:
     float process(float mic_level, float secondary_sample);
     
     void reset();
+    
+    float gain() const { return gain_; }
 
 private:
     float sample_rate_;
@@ -28,6 +30,11 @@ private:
     float env_ = 0.0f;
     float gain_ = 1.0f;
     
+    // Cached from params_ and sample_rate_ so process() does not recompute them
+    float attack_coeff_ = 0.0f;
+    float release_coeff_ = 0.0f;
+    
+    void update_coefficients();
     float calculate_target_gain(float env_db) const;
     float calculate_coefficient(float time_ms) const;
 };
@@ -4,6 +4,7 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include "TraceRecorder.hpp"
 
 class LadspaLoader {
 public:
@@ -32,15 +33,21 @@ public:
     
     void connect_control_ports(const std::vector<float>& parameters);
     
+    // Realtime-safe update of an already connected control port
+    void set_control(size_t index, float value);
+    
     void run(unsigned long sample_count);
     
     bool is_loaded() const { return info_.instance != nullptr; }
     
     const PluginInfo& get_info() const { return info_; }
+    
+    void set_trace_recorder(TraceRecorder* recorder) { trace_ = recorder; }
 
 private:
     PluginInfo info_;
     std::vector<float> control_params_;
+    TraceRecorder* trace_ = nullptr;
     
     void scan_ports();
     std::vector<std::string> get_ladspa_paths() const;
@@ -0,0 +1,76 @@
+#pragma once
+
+// Layout of the shared-memory segment tpipe publishes its meters through.
+// This header is self-contained so external readers can include it as is.
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+enum MeterChannel : uint32_t {
+    METER_MIC_L = 0,
+    METER_MIC_R,
+    METER_SEC_L,
+    METER_SEC_R,
+    METER_OUT_L,
+    METER_OUT_R,
+    METER_CHANNEL_COUNT
+};
+
+struct MeterSnapshot {
+    float peak[METER_CHANNEL_COUNT];    // Linear block peak per channel
+    float rms[METER_CHANNEL_COUNT];     // Linear block RMS per channel
+    float mic_envelope;                 // Peak of the ducker sidechain level
+    float duck_gain_l;                  // Current linear ducking gain
+    float duck_gain_r;
+    uint32_t nframes;                   // Size of the measured block
+    uint64_t block_count;               // Blocks published since start
+};
+
+struct MeterSegment {
+    static constexpr uint32_t MAGIC = 0x74706d31;  // "tpm1"
+    static constexpr uint32_t VERSION = 1;
+    static constexpr const char* NAME_PREFIX = "/tpipe-meters-";
+
+    uint32_t magic;
+    uint32_t version;
+    std::atomic<uint32_t> sequence;     // Seqlock: odd while a write is in progress
+    uint32_t reserved;
+    MeterSnapshot snapshot;
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free,
+              "Seqlock counter must be lock-free to live in shared memory");
+static_assert(std::is_standard_layout<MeterSegment>::value,
+              "MeterSegment is shared between processes");
+
+// Reader side of the seqlock. Never blocks the writer; returns false if a
+// consistent copy could not be taken within max_attempts.
+inline bool read_meter_snapshot(const MeterSegment& segment, MeterSnapshot& out,
+                                int max_attempts = 64) {
+    for (int attempt = 0; attempt < max_attempts; ++attempt) {
+        uint32_t before = segment.sequence.load(std::memory_order_acquire);
+        if (before & 1u) continue;
+
+        out = segment.snapshot;
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint32_t after = segment.sequence.load(std::memory_order_relaxed);
+        if (before == after) return true;
+    }
+    return false;
+}
+
+// Each tpipe instance publishes under its JACK client name, e.g. the client
+// "tpipe" uses "/tpipe-meters-tpipe". Characters other than [A-Za-z0-9._-]
+// are replaced with '_'.
+inline std::string meter_segment_name(const std::string& client_name) {
+    std::string name = MeterSegment::NAME_PREFIX;
+    for (char c : client_name) {
+        bool keep = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                    (c >= '0' && c <= '9') || c == '.' || c == '_' || c == '-';
+        name += keep ? c : '_';
+    }
+    return name;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+class NoiseGate {
+public:
+    struct Parameters {
+        float threshold_db = -45.0f;
+        float range_db = -25.0f;
+        float attack_ms = 2.0f;
+        float release_ms = 80.0f;
+    };
+
+    explicit NoiseGate(float sample_rate)
+        : NoiseGate(sample_rate, Parameters{}) {}
+
+    NoiseGate(float sample_rate, const Parameters& params);
+
+    void set_sample_rate(float sample_rate);
+    void set_parameters(const Parameters& params);
+
+    float process(float input);
+
+    void reset();
+
+private:
+    float sample_rate_;
+    Parameters params_;
+    float env_ = 0.0f;
+    float gain_ = 1.0f;
+
+    // Cached values derived from params_ and sample_rate_
+    float threshold_lin_ = 0.0f;
+    float range_lin_ = 0.0f;
+    float attack_coeff_ = 0.0f;
+    float release_coeff_ = 0.0f;
+
+    void update_coefficients();
+    float calculate_coefficient(float time_ms) const;
+};
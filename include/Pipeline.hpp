@@ -0,0 +1,61 @@
+#pragma once
+
+#include <tuple>
+
+// One stereo sample moving through a pipeline. The secondary pair carries
+// the background signal for stages that mix it in; it is zero when the
+// pipeline is run without a secondary source.
+struct StereoFrame {
+    float l;
+    float r;
+    float sec_l;
+    float sec_r;
+};
+
+// Statically composed chain of per-sample stages. Each stage is any type
+// with `void operator()(StereoFrame&)`; the whole chain is expanded into a
+// single loop so a block is read and written exactly once, with no
+// intermediate buffers or virtual dispatch between stages.
+template <typename... Stages>
+class Pipeline {
+public:
+    explicit Pipeline(Stages&... stages) : stages_(stages...) {}
+
+    void run(unsigned long nframes,
+             const float* in_l, const float* in_r,
+             const float* sec_l, const float* sec_r,
+             float* out_l, float* out_r) {
+        if (sec_l && sec_r) {
+            run_impl<true>(nframes, in_l, in_r, sec_l, sec_r, out_l, out_r);
+        } else {
+            run_impl<false>(nframes, in_l, in_r, sec_l, sec_r, out_l, out_r);
+        }
+    }
+
+private:
+    std::tuple<Stages&...> stages_;
+
+    template <bool HasSecondary>
+    void run_impl(unsigned long nframes,
+                  const float* in_l, const float* in_r,
+                  const float* sec_l, const float* sec_r,
+                  float* out_l, float* out_r) {
+        for (unsigned long i = 0; i < nframes; ++i) {
+            StereoFrame frame{in_l[i], in_r[i], 0.0f, 0.0f};
+            if constexpr (HasSecondary) {
+                frame.sec_l = sec_l[i];
+                frame.sec_r = sec_r[i];
+            }
+
+            std::apply([&frame](Stages&... stage) { (stage(frame), ...); }, stages_);
+
+            out_l[i] = frame.l;
+            out_r[i] = frame.r;
+        }
+    }
+};
+
+template <typename... Stages>
+Pipeline<Stages...> make_pipeline(Stages&... stages) {
+    return Pipeline<Stages...>(stages...);
+}
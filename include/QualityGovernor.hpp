@@ -0,0 +1,90 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+
+class QualityGovernor {
+public:
+    // Ordered from most to least expensive
+    enum class Tier {
+        Full = 0,     // LADSPA plugin with configured controls
+        Reduced,      // LADSPA plugin with lowered max_df / max_erb
+        Lite,         // Built-in noise gate instead of the plugin
+        Bypass        // No suppression beyond the input filters
+    };
+
+    struct Parameters {
+        float budget = 0.9f;           // Step down above this fraction of the period
+        float recover_ratio = 0.5f;    // Step up when the projected load is below budget * recover_ratio ...
+        float recover_ms = 2000.0f;    // ... sustained for this long (doubles after a failed step up)
+        float max_recover_ms = 60000.0f;  // Backoff cap; also the re-probe interval when the projection never fits
+        float cooldown_ms = 250.0f;    // Minimum time between two tier changes
+        float trigger_ms = 50.0f;      // Accumulated over-budget time needed to step down
+        float smoothing_ms = 200.0f;   // Load envelope time constant
+        float warmup_ms = 1000.0f;     // Ignore overload right after start
+    };
+
+    struct TierChange {
+        Tier from;
+        Tier to;
+        float load;
+        std::chrono::system_clock::time_point when;
+    };
+
+    explicit QualityGovernor(float sample_rate)
+        : QualityGovernor(sample_rate, Parameters{}) {}
+
+    QualityGovernor(float sample_rate, const Parameters& params);
+
+    void set_sample_rate(float sample_rate);
+
+    // Called from the process thread once per callback with the time the
+    // callback spent. Returns the tier the next callback should run at.
+    Tier update(unsigned long nframes, double elapsed_seconds);
+
+    Tier tier() const { return tier_; }
+    float load() const { return load_; }
+
+    // Called from a non-realtime thread to collect tier changes for logging.
+    bool pop_change(TierChange& change);
+
+    static const char* tier_name(Tier tier);
+
+private:
+    static constexpr std::size_t LOG_CAPACITY = 64;
+    static constexpr int LAST_TIER = static_cast<int>(Tier::Bypass);
+    static constexpr int TIER_COUNT = LAST_TIER + 1;
+
+    float sample_rate_;
+    Parameters params_;
+
+    Tier tier_ = Tier::Full;
+    float load_ = 0.0f;
+    float since_start_ms_ = 0.0f;
+    float since_change_ms_ = 0.0f;
+    float below_ms_ = 0.0f;
+    float over_ms_ = 0.0f;
+    bool reseed_ = true;
+
+    // Per-tier cost bookkeeping used to project the load one tier up:
+    // the load when a tier was left for being too expensive, and the
+    // settled load after entering a tier from above (0 = not measured)
+    std::array<float, TIER_COUNT> left_load_{};
+    std::array<float, TIER_COUNT> entry_load_{};
+    bool entry_pending_ = false;
+
+    // Step-up backoff: required recovery time per tier, doubled when a
+    // step up from that tier is undone within one recovery period
+    std::array<float, TIER_COUNT> recover_ms_{};
+    int probe_from_ = -1;
+
+    // Single-producer / single-consumer log of tier changes
+    std::array<TierChange, LOG_CAPACITY> log_{};
+    std::atomic<std::size_t> log_head_{0};
+    std::atomic<std::size_t> log_tail_{0};
+
+    void change_tier(Tier to);
+    float projected_step_up_load(int current) const;
+};
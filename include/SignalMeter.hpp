@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+#include "MeterShm.hpp"
+
+class SignalMeter {
+public:
+    SignalMeter() = default;
+    ~SignalMeter();
+
+    // Non-copyable, non-movable (owns a shared-memory mapping)
+    SignalMeter(const SignalMeter&) = delete;
+    SignalMeter& operator=(const SignalMeter&) = delete;
+    SignalMeter(SignalMeter&&) = delete;
+    SignalMeter& operator=(SignalMeter&&) = delete;
+
+    // Creates and maps the segment. A segment left behind by a crashed
+    // instance is replaced; one held by a running instance is an error.
+    // Must be called outside the process thread.
+    bool open(const std::string& name);
+
+    bool is_open() const { return segment_ != nullptr; }
+
+    // Realtime-safe: no syscalls, no locks, no allocation
+    void measure(MeterChannel channel, const float* data, unsigned long nframes);
+    void set_ducking(float mic_envelope, float gain_l, float gain_r);
+    void publish(unsigned long nframes);
+
+private:
+    MeterSegment* segment_ = nullptr;
+    int fd_ = -1;   // Keeps the ownership lock on the segment
+    std::string name_;
+    MeterSnapshot staging_{};
+
+    void close();
+};
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class TraceRecorder {
+public:
+    enum class Event : uint16_t {
+        Process = 0,
+        InputFilters,
+        Ladspa,
+        OutputMix,
+        Fused,
+        Meter,
+        LadspaRun,
+        BufferSize,
+        Xrun,
+        TierChange,
+        Count
+    };
+
+    // Preallocates one ring per thread, sized to hold roughly `seconds` of
+    // events. Threads beyond max_threads are silently not traced.
+    explicit TraceRecorder(float seconds, unsigned max_threads = 4);
+
+    // Non-copyable, non-movable (threads cache pointers into the rings)
+    TraceRecorder(const TraceRecorder&) = delete;
+    TraceRecorder& operator=(const TraceRecorder&) = delete;
+    TraceRecorder(TraceRecorder&&) = delete;
+    TraceRecorder& operator=(TraceRecorder&&) = delete;
+
+    // Realtime-safe: a timestamp read and a store into a preallocated ring
+    void begin(Event event) { record(event, PHASE_BEGIN, 0); }
+    void end(Event event) { record(event, PHASE_END, 0); }
+    void instant(Event event, uint32_t arg) { record(event, PHASE_INSTANT, arg); }
+
+    // Realtime- and async-signal-safe; the dump itself happens in take_dump()
+    void request_dump() { dump_requested_.store(true, std::memory_order_relaxed); }
+    bool take_dump_request() { return dump_requested_.exchange(false); }
+
+    // Writes the last `seconds` of events as Chrome trace JSON.
+    // Must be called outside the process thread.
+    bool dump(const std::string& path) const;
+
+    float seconds() const { return seconds_; }
+
+    // RAII begin/end pair; a null recorder makes it a no-op
+    class Scope {
+    public:
+        Scope(TraceRecorder* recorder, Event event)
+            : recorder_(recorder), event_(event) {
+            if (recorder_) recorder_->begin(event_);
+        }
+        ~Scope() {
+            if (recorder_) recorder_->end(event_);
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        TraceRecorder* recorder_;
+        Event event_;
+    };
+
+private:
+    static constexpr uint8_t PHASE_BEGIN = 0;
+    static constexpr uint8_t PHASE_END = 1;
+    static constexpr uint8_t PHASE_INSTANT = 2;
+
+    struct Record {
+        uint64_t ticks;
+        uint32_t arg;
+        uint16_t event;
+        uint8_t phase;
+        uint8_t reserved;
+    };
+
+    struct Ring {
+        std::vector<Record> records;
+        std::atomic<uint64_t> head{0};
+    };
+
+    float seconds_;
+    uint64_t generation_;
+    uint64_t mask_;
+    std::vector<std::unique_ptr<Ring>> rings_;
+    std::atomic<unsigned> next_ring_{0};
+    std::atomic<bool> dump_requested_{false};
+
+    // Reference point for converting ticks to wall-clock microseconds
+    uint64_t base_ticks_;
+    uint64_t base_ns_;
+
+    void record(Event event, uint8_t phase, uint32_t arg);
+    Ring* thread_ring();
+
+    static uint64_t read_ticks();
+    static uint64_t steady_ns();
+    static const char* event_name(uint16_t event);
+};
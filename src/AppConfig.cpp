@@ -3,35 +3,57 @@
 #include <sstream>
 #include <algorithm>
 
+bool AppConfig::parse_line(std::string line) {
+    // Remove comments
+    if (auto pos = line.find('#'); pos != std::string::npos) {
+        line.erase(pos);
+    }
+    
+    // Trim whitespace (including CR from files with CRLF line endings)
+    line.erase(0, line.find_first_not_of(" \t\r\n"));
+    line.erase(line.find_last_not_of(" \t\r\n") + 1);
+    
+    if (line.empty()) return false;
+
+    std::stringstream ss(line);
+    std::string key, value;
+    if (std::getline(ss, key, '=') && std::getline(ss, value)) {
+        // Allow "key = value" as well as "key=value"
+        key.erase(key.find_last_not_of(" \t") + 1);
+        try {
+            params_[key] = std::stof(value);
+            return true;
+        } catch (const std::exception&) {
+            // Skip invalid values
+        }
+    }
+    return false;
+}
+
 bool AppConfig::load(const std::string& filename) {
     std::ifstream file(filename);
     if (!file.is_open()) return false;
 
     std::string line;
     while (std::getline(file, line)) {
-        // Remove comments
-        if (auto pos = line.find('#'); pos != std::string::npos) {
-            line.erase(pos);
-        }
-        
-        // Trim whitespace
-        line.erase(0, line.find_first_not_of(" \t"));
-        line.erase(line.find_last_not_of(" \t") + 1);
-        
-        if (line.empty()) continue;
+        parse_line(line);
+    }
+    return true;
+}
 
-        std::stringstream ss(line);
-        std::string key, value;
-        if (std::getline(ss, key, '=') && std::getline(ss, value)) {
-            try {
-                params_[key] = std::stof(value);
-            } catch (const std::exception&) {
-                // Skip invalid values
-                continue;
-            }
+bool AppConfig::load_string(const std::string& text) {
+    bool parsed = false;
+    std::string entry;
+    for (char c : text) {
+        if (c == '\n' || c == ';' || c == ',') {
+            parsed |= parse_line(entry);
+            entry.clear();
+        } else {
+            entry += c;
         }
     }
-    return true;
+    parsed |= parse_line(entry);
+    return parsed;
 }
 
 float AppConfig::get(const std::string& key, float default_val) const {
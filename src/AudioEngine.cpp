@@ -1,14 +1,74 @@
 #include "AudioEngine.hpp"
+#include "Pipeline.hpp"
 #include <iostream>
 #include <algorithm>
 #include <cmath>
+#include <chrono>
+#include <ctime>
+#include <iomanip>
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
+
+namespace {
+    using Tier = QualityGovernor::Tier;
+    
+    bool uses_plugin(Tier tier) {
+        return tier == Tier::Full || tier == Tier::Reduced;
+    }
+    
+    // Full and Reduced differ only in control values, not in signal path
+    bool same_path(Tier a, Tier b) {
+        return a == b || (uses_plugin(a) && uses_plugin(b));
+    }
+    
+    // Per-sample pipeline stages; see Pipeline.hpp
+    struct FilterStage {
+        VoiceIndoorFilter& l;
+        VoiceIndoorFilter& r;
+        
+        void operator()(StereoFrame& frame) {
+            frame.l = l.process(frame.l);
+            frame.r = r.process(frame.r);
+        }
+    };
+    
+    struct GateStage {
+        NoiseGate& l;
+        NoiseGate& r;
+        
+        void operator()(StereoFrame& frame) {
+            frame.l = l.process(frame.l);
+            frame.r = r.process(frame.r);
+        }
+    };
+    
+    // Adds the ducked secondary signal on top of the processed mic
+    struct DuckMixStage {
+        Ducker& l;
+        Ducker& r;
+        float mic_envelope = 0.0f;
+        
+        void operator()(StereoFrame& frame) {
+            float mic_level = std::abs(frame.l + frame.r) * 0.5f;
+            mic_envelope = std::max(mic_envelope, mic_level);
+            
+            frame.l += l.process(mic_level, frame.sec_l);
+            frame.r += r.process(mic_level, frame.sec_r);
+        }
+    };
+}
 
 AudioEngine::AudioEngine(const AppConfig& config)
     : config_(config) {}
 
 AudioEngine::~AudioEngine() {
-    if (client_) {
+    if (!client_) return;
+    
+    if (owns_client_) {
         jack_client_close(client_);
+    } else {
+        jack_deactivate(client_);
     }
 }
 
@@ -55,6 +115,13 @@ void AudioEngine::initialize_processors(float sample_rate) {
     
     ducker_l_ = std::make_unique<Ducker>(sample_rate, ducker_params);
     ducker_r_ = std::make_unique<Ducker>(sample_rate, ducker_params);
+    
+    NoiseGate::Parameters gate_params;
+    gate_params.threshold_db = config_.get("gate_threshold_db", -45.0f);
+    gate_params.range_db = config_.get("gate_range_db", -25.0f);
+    
+    gate_l_ = std::make_unique<NoiseGate>(sample_rate, gate_params);
+    gate_r_ = std::make_unique<NoiseGate>(sample_rate, gate_params);
 }
 
 bool AudioEngine::load_ladspa_plugin(float sample_rate) {
@@ -65,11 +132,16 @@ bool AudioEngine::load_ladspa_plugin(float sample_rate) {
         return false;
     }
     
+    max_erb_ = config_.get("max_erb", 35.0f);
+    max_df_ = config_.get("max_df", 35.0f);
+    reduced_max_erb_ = config_.get("reduced_max_erb", 20.0f);
+    reduced_max_df_ = config_.get("reduced_max_df", 20.0f);
+    
     std::vector<float> params = {
         config_.get("attenuation_limit", 80.0f),
         config_.get("min_thresh", -15.0f),
-        config_.get("max_erb", 35.0f),
-        config_.get("max_df", 35.0f),
+        max_erb_,
+        max_df_,
         config_.get("min_buf", 0.0f),
         config_.get("post_beta", 0.0f)
     };
@@ -78,19 +150,85 @@ bool AudioEngine::load_ladspa_plugin(float sample_rate) {
     return true;
 }
 
+void AudioEngine::initialize_governor(float sample_rate) {
+    // Opt-in: degrading quality is a trade-off users have to ask for
+    if (config_.get("governor_enabled", 0.0f) == 0.0f) {
+        return;
+    }
+    
+    QualityGovernor::Parameters params;
+    params.budget = config_.get("governor_budget", 0.9f);
+    params.recover_ratio = config_.get("governor_recover_ratio", 0.5f);
+    params.recover_ms = config_.get("governor_recover_ms", 2000.0f);
+    params.cooldown_ms = config_.get("governor_cooldown_ms", 250.0f);
+    params.trigger_ms = config_.get("governor_trigger_ms", 50.0f);
+    
+    governor_ = std::make_unique<QualityGovernor>(sample_rate, params);
+    
+    auto to_frames = [sample_rate](float ms) {
+        return static_cast<jack_nframes_t>(std::max(ms, 0.0f) * 0.001f * sample_rate);
+    };
+    fade_len_ = to_frames(config_.get("governor_fade_ms", 20.0f));
+    preroll_len_ = to_frames(config_.get("governor_preroll_ms", 100.0f));
+}
+
+void AudioEngine::initialize_meter() {
+    if (config_.get("meters_enabled", 1.0f) == 0.0f) {
+        return;
+    }
+    
+    meter_ = std::make_unique<SignalMeter>();
+    if (!meter_->open(meter_segment_name(jack_get_client_name(client_)))) {
+        std::cerr << "Signal meters unavailable.\n";
+        meter_.reset();
+    }
+}
+
+void AudioEngine::initialize_trace() {
+    if (config_.get("trace_enabled", 0.0f) == 0.0f) {
+        return;
+    }
+    
+    trace_ = std::make_unique<TraceRecorder>(config_.get("trace_seconds", 5.0f));
+    
+    if (ladspa_loader_) {
+        ladspa_loader_->set_trace_recorder(trace_.get());
+    }
+    
+    // Other dump triggers (e.g. SIGUSR1) are announced by whoever installs them
+    std::cout << "Tracing enabled. The last " << trace_->seconds()
+              << " s of stage timings are dumped on xrun.\n";
+}
+
 bool AudioEngine::initialize() {
     if (!create_jack_client()) {
         return false;
     }
     
+    return setup_client();
+}
+
+bool AudioEngine::initialize(jack_client_t* client) {
+    client_ = client;
+    owns_client_ = false;
+    
+    return setup_client();
+}
+
+bool AudioEngine::setup_client() {
     float sample_rate = static_cast<float>(jack_get_sample_rate(client_));
     
     register_jack_ports();
     initialize_processors(sample_rate);
-    load_ladspa_plugin(sample_rate);
+    if (load_ladspa_plugin(sample_rate)) {
+        initialize_governor(sample_rate);
+    }
+    initialize_meter();
+    initialize_trace();
     
     jack_set_process_callback(client_, AudioEngine::static_process_callback, this);
     jack_set_buffer_size_callback(client_, AudioEngine::static_bufsize_callback, this);
+    jack_set_xrun_callback(client_, AudioEngine::static_xrun_callback, this);
     
     if (jack_activate(client_) != 0) {
         std::cerr << "Failed to activate JACK client\n";
@@ -108,11 +246,29 @@ int AudioEngine::static_bufsize_callback(jack_nframes_t nframes, void* arg) {
     return static_cast<AudioEngine*>(arg)->on_buffer_size_change(nframes);
 }
 
+int AudioEngine::static_xrun_callback(void* arg) {
+    return static_cast<AudioEngine*>(arg)->on_xrun();
+}
+
+int AudioEngine::on_xrun() {
+    if (trace_) {
+        trace_->instant(TraceRecorder::Event::Xrun, 0);
+        trace_->request_dump();
+    }
+    return 0;
+}
+
 int AudioEngine::on_buffer_size_change(jack_nframes_t nframes) {
+    if (trace_) {
+        trace_->instant(TraceRecorder::Event::BufferSize, nframes);
+    }
+    
     buf_in_l_.resize(nframes);
     buf_in_r_.resize(nframes);
     buf_out_l_.resize(nframes);
     buf_out_r_.resize(nframes);
+    buf_fade_l_.resize(nframes);
+    buf_fade_r_.resize(nframes);
     
     if (ladspa_loader_ && ladspa_loader_->is_loaded()) {
         std::vector<float*> inputs = {buf_in_l_.data(), buf_in_r_.data()};
@@ -125,34 +281,146 @@ int AudioEngine::on_buffer_size_change(jack_nframes_t nframes) {
 
 void AudioEngine::process_input_filters(jack_nframes_t nframes, 
                                        float* in_l, float* in_r) {
-    for (jack_nframes_t i = 0; i < nframes; ++i) {
-        buf_in_l_[i] = filter_l_->process(in_l[i]);
-        buf_in_r_[i] = filter_r_->process(in_r[i]);
+    TraceRecorder::Scope scope(trace_.get(), TraceRecorder::Event::InputFilters);
+    FilterStage filter{*filter_l_, *filter_r_};
+    make_pipeline(filter).run(nframes, in_l, in_r, nullptr, nullptr,
+                              buf_in_l_.data(), buf_in_r_.data());
+}
+
+void AudioEngine::render_tier(QualityGovernor::Tier tier, jack_nframes_t nframes,
+                              float*& dst_l, float*& dst_r) {
+    switch (tier) {
+        case Tier::Full:
+        case Tier::Reduced:
+            // The plugin is wired to buf_out_*, dst must point there
+            ladspa_loader_->run(nframes);
+            break;
+        case Tier::Lite: {
+            GateStage gate{*gate_l_, *gate_r_};
+            make_pipeline(gate).run(nframes, buf_in_l_.data(), buf_in_r_.data(),
+                                    nullptr, nullptr, dst_l, dst_r);
+            break;
+        }
+        case Tier::Bypass:
+            // Alias the filtered input instead of copying it
+            dst_l = buf_in_l_.data();
+            dst_r = buf_in_r_.data();
+            break;
+    }
+}
+
+void AudioEngine::apply_tier() {
+    if (!governor_) return;
+    
+    Tier next = governor_->tier();
+    if (next == active_tier_) return;
+    
+    if (next == Tier::Full) {
+        ladspa_loader_->set_control(CONTROL_MAX_ERB, max_erb_);
+        ladspa_loader_->set_control(CONTROL_MAX_DF, max_df_);
+    } else if (next == Tier::Reduced) {
+        ladspa_loader_->set_control(CONTROL_MAX_ERB, reduced_max_erb_);
+        ladspa_loader_->set_control(CONTROL_MAX_DF, reduced_max_df_);
+    }
+    
+    if (!same_path(next, active_tier_)) {
+        fade_from_ = active_tier_;
+        fade_pos_ = 0;
+        
+        // The plugin's internal state is stale after a pause; let it run on
+        // live input before any of its output is faded in
+        fade_preroll_ = uses_plugin(next) ? preroll_len_ : 0;
     }
+    
+    active_tier_ = next;
+    
+    if (trace_) {
+        trace_->instant(TraceRecorder::Event::TierChange, static_cast<uint32_t>(next));
+    }
+}
+
+bool AudioEngine::is_fading() const {
+    return fade_pos_ < fade_preroll_ + fade_len_ && !same_path(fade_from_, active_tier_);
 }
 
 void AudioEngine::process_ladspa(jack_nframes_t nframes) {
-    if (ladspa_loader_ && ladspa_loader_->is_loaded()) {
+    TraceRecorder::Scope scope(trace_.get(), TraceRecorder::Event::Ladspa);
+    
+    if (!is_fading()) {
         ladspa_loader_->run(nframes);
-    } else {
-        // Bypass mode
-        std::copy(buf_in_l_.begin(), buf_in_l_.begin() + nframes, buf_out_l_.begin());
-        std::copy(buf_in_r_.begin(), buf_in_r_.begin() + nframes, buf_out_r_.begin());
+        return;
     }
+    
+    // Crossfade between the outgoing and incoming tier. Whichever of the two
+    // runs the plugin has to render into buf_out_*, the other uses buf_fade_*.
+    float* new_l = buf_out_l_.data();
+    float* new_r = buf_out_r_.data();
+    float* old_l = buf_fade_l_.data();
+    float* old_r = buf_fade_r_.data();
+    
+    if (uses_plugin(fade_from_)) {
+        std::swap(new_l, old_l);
+        std::swap(new_r, old_r);
+    }
+    
+    render_tier(active_tier_, nframes, new_l, new_r);
+    render_tier(fade_from_, nframes, old_l, old_r);
+    
+    float step = 1.0f / static_cast<float>(std::max<jack_nframes_t>(fade_len_, 1));
+    for (jack_nframes_t i = 0; i < nframes; ++i) {
+        float pos = static_cast<float>(fade_pos_ + i) - static_cast<float>(fade_preroll_);
+        float g = std::clamp(pos * step, 0.0f, 1.0f);
+        buf_out_l_[i] = old_l[i] + g * (new_l[i] - old_l[i]);
+        buf_out_r_[i] = old_r[i] + g * (new_r[i] - old_r[i]);
+    }
+    
+    fade_pos_ = std::min(fade_pos_ + nframes, fade_preroll_ + fade_len_);
 }
 
 void AudioEngine::process_output_mix(jack_nframes_t nframes,
                                      float* sec_l, float* sec_r,
                                      float* out_l, float* out_r) {
-    for (jack_nframes_t i = 0; i < nframes; ++i) {
-        float mic_level = std::abs(buf_out_l_[i] + buf_out_r_[i]) * 0.5f;
-        
-        out_l[i] = buf_out_l_[i] + ducker_l_->process(mic_level, sec_l[i]);
-        out_r[i] = buf_out_r_[i] + ducker_r_->process(mic_level, sec_r[i]);
+    TraceRecorder::Scope scope(trace_.get(), TraceRecorder::Event::OutputMix);
+    DuckMixStage mix{*ducker_l_, *ducker_r_};
+    make_pipeline(mix).run(nframes, buf_out_l_.data(), buf_out_r_.data(),
+                           sec_l, sec_r, out_l, out_r);
+    mic_envelope_ = mix.mic_envelope;
+}
+
+void AudioEngine::process_fused(jack_nframes_t nframes, Tier tier,
+                                float* in_l, float* in_r, float* sec_l, float* sec_r,
+                                float* out_l, float* out_r) {
+    TraceRecorder::Scope scope(trace_.get(), TraceRecorder::Event::Fused);
+    FilterStage filter{*filter_l_, *filter_r_};
+    DuckMixStage mix{*ducker_l_, *ducker_r_};
+    
+    if (tier == Tier::Lite) {
+        GateStage gate{*gate_l_, *gate_r_};
+        make_pipeline(filter, gate, mix).run(nframes, in_l, in_r, sec_l, sec_r, out_l, out_r);
+    } else {
+        make_pipeline(filter, mix).run(nframes, in_l, in_r, sec_l, sec_r, out_l, out_r);
     }
+    
+    mic_envelope_ = mix.mic_envelope;
+}
+
+void AudioEngine::update_meter(jack_nframes_t nframes, float* in_l, float* in_r,
+                               float* sec_l, float* sec_r, float* out_l, float* out_r) {
+    TraceRecorder::Scope scope(trace_.get(), TraceRecorder::Event::Meter);
+    meter_->measure(METER_MIC_L, in_l, nframes);
+    meter_->measure(METER_MIC_R, in_r, nframes);
+    meter_->measure(METER_SEC_L, sec_l, nframes);
+    meter_->measure(METER_SEC_R, sec_r, nframes);
+    meter_->measure(METER_OUT_L, out_l, nframes);
+    meter_->measure(METER_OUT_R, out_r, nframes);
+    meter_->set_ducking(mic_envelope_, ducker_l_->gain(), ducker_r_->gain());
+    meter_->publish(nframes);
 }
 
 int AudioEngine::process(jack_nframes_t nframes) {
+    TraceRecorder::Scope scope(trace_.get(), TraceRecorder::Event::Process);
+    auto start = std::chrono::steady_clock::now();
+    
     auto get_buffer = [this, nframes](jack_port_t* port) {
         return static_cast<float*>(jack_port_get_buffer(port, nframes));
     };
@@ -164,9 +432,79 @@ int AudioEngine::process(jack_nframes_t nframes) {
     float* out_l = get_buffer(out_l_);
     float* out_r = get_buffer(out_r_);
     
-    process_input_filters(nframes, in_l, in_r);
-    process_ladspa(nframes);
-    process_output_mix(nframes, sec_l, sec_r, out_l, out_r);
+    apply_tier();
+    
+    bool plugin_loaded = ladspa_loader_ && ladspa_loader_->is_loaded();
+    Tier tier = plugin_loaded ? active_tier_ : Tier::Bypass;
+    
+    if (uses_plugin(tier) || is_fading()) {
+        // Intermediate buffers only exist around the LADSPA boundary
+        process_input_filters(nframes, in_l, in_r);
+        process_ladspa(nframes);
+        process_output_mix(nframes, sec_l, sec_r, out_l, out_r);
+    } else {
+        process_fused(nframes, tier, in_l, in_r, sec_l, sec_r, out_l, out_r);
+    }
+    
+    if (meter_) {
+        update_meter(nframes, in_l, in_r, sec_l, sec_r, out_l, out_r);
+    }
+    
+    if (governor_) {
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        governor_->update(nframes, elapsed.count());
+    }
     
     return 0;
 }
+
+void AudioEngine::request_trace_dump() {
+    if (trace_) {
+        trace_->request_dump();
+    }
+}
+
+void AudioEngine::write_trace_dump() {
+    const char* tmpdir = std::getenv("TMPDIR");
+    std::time_t now = std::time(nullptr);
+    
+    std::string path = std::string(tmpdir ? tmpdir : "/tmp") + "/tpipe-trace-"
+                     + std::to_string(getpid()) + "-" + std::to_string(now) + ".json";
+    
+    if (trace_->dump(path)) {
+        std::cout << "Trace written to " << path << "\n";
+    } else {
+        std::cerr << "Failed to write trace to " << path << "\n";
+    }
+}
+
+void AudioEngine::poll() {
+    if (trace_) {
+        // Back-to-back xruns are coalesced into one dump per trace window
+        auto now = std::chrono::steady_clock::now();
+        std::chrono::duration<float> since_dump = now - last_trace_dump_;
+        
+        if (since_dump.count() >= trace_->seconds() && trace_->take_dump_request()) {
+            write_trace_dump();
+            last_trace_dump_ = now;
+        }
+    }
+    
+    if (!governor_) return;
+    
+    QualityGovernor::TierChange change;
+    while (governor_->pop_change(change)) {
+        std::time_t t = std::chrono::system_clock::to_time_t(change.when);
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            change.when.time_since_epoch()).count() % 1000;
+        
+        std::tm tm{};
+        localtime_r(&t, &tm);
+        
+        std::cout << "[" << std::put_time(&tm, "%Y-%m-%d %H:%M:%S") << "."
+                  << std::setfill('0') << std::setw(3) << ms << std::setfill(' ')
+                  << "] Quality tier " << QualityGovernor::tier_name(change.from)
+                  << " -> " << QualityGovernor::tier_name(change.to)
+                  << " (load " << static_cast<int>(change.load * 100.0f) << "%)\n";
+    }
+}
@@ -3,14 +3,23 @@
 #include <algorithm>
 
 Ducker::Ducker(float sample_rate, const Parameters& params)
-    : sample_rate_(sample_rate), params_(params), env_(0.0f), gain_(1.0f) {}
+    : sample_rate_(sample_rate), params_(params), env_(0.0f), gain_(1.0f) {
+    update_coefficients();
+}
 
 void Ducker::set_sample_rate(float sample_rate) {
     sample_rate_ = sample_rate;
+    update_coefficients();
 }
 
 void Ducker::set_parameters(const Parameters& params) {
     params_ = params;
+    update_coefficients();
+}
+
+void Ducker::update_coefficients() {
+    attack_coeff_ = calculate_coefficient(params_.attack_ms);
+    release_coeff_ = calculate_coefficient(params_.release_ms);
 }
 
 float Ducker::calculate_target_gain(float env_db) const {
@@ -46,16 +55,13 @@ float Ducker::process(float mic_level, float secondary_sample) {
     float env_db = 20.0f * std::log10(std::abs(mic_level) + 1e-8f);
     float target_gain = calculate_target_gain(env_db);
     
-    float attack_coeff = calculate_coefficient(params_.attack_ms);
-    float release_coeff = calculate_coefficient(params_.release_ms);
-    
     // Smooth gain transitions
     if (target_gain < gain_) {
         // Attacking (Ducking down)
-        gain_ = target_gain + attack_coeff * (gain_ - target_gain);
+        gain_ = target_gain + attack_coeff_ * (gain_ - target_gain);
     } else {
         // Releasing (Returning to full volume)
-        gain_ = target_gain + release_coeff * (gain_ - target_gain);
+        gain_ = target_gain + release_coeff_ * (gain_ - target_gain);
     }
 
     return secondary_sample * gain_;
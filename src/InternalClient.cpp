@@ -0,0 +1,96 @@
+#include "AudioEngine.hpp"
+#include "AppConfig.hpp"
+#include <jack/jack.h>
+#include <iostream>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <filesystem>
+
+// Entry points for running tpipe inside jackd:
+//
+//   jack_load tpipe tpipe -i "/etc/tpipe/config.conf"
+//   jack_load tpipe tpipe -i "threshold_db=-30,ducking_db=-50"
+//
+// The init string is either inline "key=value" entries or, if it contains
+// no '=', a configuration file path; an empty string falls back to the
+// default file.
+
+namespace {
+    struct InternalClient {
+        AppConfig config;
+        std::unique_ptr<AudioEngine> engine;
+        std::atomic<bool> running{true};
+        std::thread housekeeping;
+        
+        ~InternalClient() {
+            running = false;
+            if (housekeeping.joinable()) {
+                housekeeping.join();
+            }
+        }
+    };
+    
+    // jackd loads a module once per process; a second jack_load of the same
+    // module shares these globals, so only one instance is allowed
+    std::unique_ptr<InternalClient> instance;
+    
+    bool load_config(AppConfig& config, const std::string& init) {
+        if (init.empty()) {
+            return std::filesystem::exists(DEFAULT_CONFIG_PATH)
+                && config.load(DEFAULT_CONFIG_PATH);
+        }
+        
+        // Anything without a key=value pair is a path, and must exist
+        if (init.find('=') == std::string::npos) {
+            if (!std::filesystem::exists(init)) {
+                std::cerr << "tpipe: configuration file not found: " << init << "\n";
+                return false;
+            }
+            return config.load(init);
+        }
+        
+        return config.load_string(init);
+    }
+}
+
+extern "C" int jack_initialize(jack_client_t* client, const char* load_init) {
+    if (instance) {
+        std::cerr << "tpipe: in-process client is already loaded\n";
+        return 1;
+    }
+    
+    auto state = std::make_unique<InternalClient>();
+    std::string init = load_init ? load_init : "";
+    
+    if (!load_config(state->config, init)) {
+        std::cerr << "tpipe: failed to load configuration from '" << init << "'\n";
+        return 1;
+    }
+    
+    state->engine = std::make_unique<AudioEngine>(state->config);
+    if (!state->engine->initialize(client)) {
+        std::cerr << "tpipe: failed to initialize audio engine\n";
+        return 1;
+    }
+    
+    // Stands in for the standalone main loop
+    InternalClient* raw = state.get();
+    state->housekeeping = std::thread([raw]() {
+        while (raw->running) {
+            raw->engine->poll();
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+    });
+    
+    instance = std::move(state);
+    std::cout << "tpipe: running as in-process client\n";
+    return 0;
+}
+
+extern "C" void jack_finish(void* /*arg*/) {
+    // Joins the housekeeping thread, then deactivates the engine
+    instance.reset();
+}
@@ -117,7 +117,15 @@ void LadspaLoader::connect_control_ports(const std::vector<float>& parameters) {
     }
 }
 
+void LadspaLoader::set_control(size_t index, float value) {
+    if (index < control_params_.size()) {
+        control_params_[index] = value;
+    }
+}
+
 void LadspaLoader::run(unsigned long sample_count) {
+    TraceRecorder::Scope scope(trace_, TraceRecorder::Event::LadspaRun);
+    
     if (info_.instance && info_.descriptor && info_.descriptor->run) {
         info_.descriptor->run(info_.instance, sample_count);
     }
@@ -0,0 +1,52 @@
+#include "NoiseGate.hpp"
+#include <cmath>
+#include <algorithm>
+
+NoiseGate::NoiseGate(float sample_rate, const Parameters& params)
+    : sample_rate_(sample_rate), params_(params) {
+    update_coefficients();
+}
+
+void NoiseGate::set_sample_rate(float sample_rate) {
+    sample_rate_ = sample_rate;
+    update_coefficients();
+}
+
+void NoiseGate::set_parameters(const Parameters& params) {
+    params_ = params;
+    update_coefficients();
+}
+
+float NoiseGate::calculate_coefficient(float time_ms) const {
+    if (sample_rate_ <= 0.0f || time_ms <= 0.0f) return 0.0f;
+    return std::exp(-1.0f / (time_ms * 0.001f * sample_rate_));
+}
+
+void NoiseGate::update_coefficients() {
+    // Everything is precomputed so process() stays free of transcendentals;
+    // the gate is the cheap fallback used when the system is overloaded.
+    threshold_lin_ = std::pow(10.0f, params_.threshold_db / 20.0f);
+    range_lin_ = std::pow(10.0f, params_.range_db / 20.0f);
+    attack_coeff_ = calculate_coefficient(params_.attack_ms);
+    release_coeff_ = calculate_coefficient(params_.release_ms);
+}
+
+float NoiseGate::process(float input) {
+    // Peak envelope follower: fast rise, release-speed fall
+    float level = std::abs(input);
+    float env_coeff = (level > env_) ? attack_coeff_ : release_coeff_;
+    env_ = level + env_coeff * (env_ - level);
+
+    float target_gain = (env_ >= threshold_lin_) ? 1.0f : range_lin_;
+
+    // Open quickly, close slowly to avoid chopping word tails
+    float gain_coeff = (target_gain > gain_) ? attack_coeff_ : release_coeff_;
+    gain_ = target_gain + gain_coeff * (gain_ - target_gain);
+
+    return input * gain_;
+}
+
+void NoiseGate::reset() {
+    env_ = 0.0f;
+    gain_ = 1.0f;
+}
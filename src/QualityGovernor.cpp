@@ -0,0 +1,147 @@
+#include "QualityGovernor.hpp"
+#include <cmath>
+#include <algorithm>
+
+QualityGovernor::QualityGovernor(float sample_rate, const Parameters& params)
+    : sample_rate_(sample_rate), params_(params) {
+    recover_ms_.fill(params_.recover_ms);
+}
+
+void QualityGovernor::set_sample_rate(float sample_rate) {
+    sample_rate_ = sample_rate;
+}
+
+float QualityGovernor::projected_step_up_load(int current) const {
+    // Lite and bypass do not run the plugin, so the load measured there says
+    // nothing about what the tier above costs. Add the difference observed
+    // when we stepped down.
+    float above = left_load_[current - 1];
+    float here = entry_load_[current];
+    if (above <= 0.0f || here <= 0.0f) return load_;
+
+    return load_ + std::max(above - here, 0.0f);
+}
+
+QualityGovernor::Tier QualityGovernor::update(unsigned long nframes,
+                                              double elapsed_seconds) {
+    if (sample_rate_ <= 0.0f || nframes == 0) return tier_;
+
+    float period_ms = 1000.0f * static_cast<float>(nframes) / sample_rate_;
+    float instant = static_cast<float>(elapsed_seconds * 1000.0) / period_ms;
+
+    if (reseed_) {
+        load_ = instant;
+        reseed_ = false;
+    } else {
+        float coeff = std::exp(-period_ms / std::max(params_.smoothing_ms, 1.0f));
+        load_ = instant + coeff * (load_ - instant);
+    }
+
+    since_start_ms_ += period_ms;
+    since_change_ms_ += period_ms;
+
+    // Leaky bucket of over-budget time: a single slow callback does not
+    // trigger a step down, sustained or frequent spikes do
+    if (instant > params_.budget) {
+        over_ms_ += period_ms;
+    } else {
+        over_ms_ = std::max(over_ms_ - 0.5f * period_ms, 0.0f);
+    }
+
+    int current = static_cast<int>(tier_);
+
+    if (entry_pending_ && since_change_ms_ >= params_.cooldown_ms) {
+        entry_load_[current] = load_;
+        entry_pending_ = false;
+    }
+
+    // A step up that survived a full recovery period resets the backoff
+    if (probe_from_ >= 0 && since_change_ms_ >= recover_ms_[probe_from_]) {
+        recover_ms_[probe_from_] = params_.recover_ms;
+        probe_from_ = -1;
+    }
+
+    if (since_start_ms_ < params_.warmup_ms || since_change_ms_ < params_.cooldown_ms) {
+        return tier_;
+    }
+
+    if (over_ms_ >= params_.trigger_ms && current < LAST_TIER) {
+        change_tier(static_cast<Tier>(current + 1));
+        return tier_;
+    }
+
+    float target = params_.budget * params_.recover_ratio;
+
+    if (current > 0 && load_ < target) {
+        below_ms_ += period_ms;
+
+        // If the projection says the tier above will not fit, only re-probe
+        // occasionally in case the cost estimate is out of date
+        float required = (projected_step_up_load(current) < target)
+            ? recover_ms_[current] : params_.max_recover_ms;
+
+        if (below_ms_ >= required) {
+            change_tier(static_cast<Tier>(current - 1));
+        }
+    } else {
+        below_ms_ = 0.0f;
+    }
+
+    return tier_;
+}
+
+void QualityGovernor::change_tier(Tier to) {
+    int from = static_cast<int>(tier_);
+    int next_tier = static_cast<int>(to);
+
+    std::size_t head = log_head_.load(std::memory_order_relaxed);
+    std::size_t next = (head + 1) % LOG_CAPACITY;
+
+    // Drop the entry rather than block if nobody is draining the log
+    if (next != log_tail_.load(std::memory_order_acquire)) {
+        log_[head] = TierChange{tier_, to, load_, std::chrono::system_clock::now()};
+        log_head_.store(next, std::memory_order_release);
+    }
+
+    if (next_tier > from) {
+        left_load_[from] = load_;
+        entry_pending_ = true;
+
+        // Stepping straight back down from a tier we just probed
+        if (probe_from_ == next_tier) {
+            recover_ms_[next_tier] = std::min(recover_ms_[next_tier] * 2.0f,
+                                              params_.max_recover_ms);
+        }
+        probe_from_ = -1;
+    } else {
+        probe_from_ = from;
+        entry_pending_ = false;
+    }
+
+    tier_ = to;
+    since_change_ms_ = 0.0f;
+    below_ms_ = 0.0f;
+    over_ms_ = 0.0f;
+
+    // The measured load belongs to the previous tier; start fresh
+    reseed_ = true;
+}
+
+bool QualityGovernor::pop_change(TierChange& change) {
+    std::size_t tail = log_tail_.load(std::memory_order_relaxed);
+    if (tail == log_head_.load(std::memory_order_acquire)) return false;
+
+    change = log_[tail];
+    log_tail_.store((tail + 1) % LOG_CAPACITY, std::memory_order_release);
+    return true;
+}
+
+const char* QualityGovernor::tier_name(Tier tier) {
+    switch (tier) {
+        case Tier::Full:    return "full";
+        case Tier::Reduced: return "reduced";
+        case Tier::Lite:    return "lite";
+        case Tier::Bypass:  return "bypass";
+    }
+    return "unknown";
+}
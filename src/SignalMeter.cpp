@@ -0,0 +1,201 @@
+#include "SignalMeter.hpp"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/file.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <iostream>
+#include <new>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define TPIPE_METER_SSE 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define TPIPE_METER_NEON 1
+#endif
+
+namespace {
+    // Peak and sum of squares over a block, eight samples per iteration in
+    // two 4-wide vectors. The scalar tail handles the last < 8 samples.
+    void measure_block(const float* data, unsigned long nframes,
+                       float& peak, float& rms) {
+        unsigned long i = 0;
+        float p = 0.0f;
+        float sum = 0.0f;
+
+#if defined(TPIPE_METER_SSE)
+        const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+        __m128 peak0 = _mm_setzero_ps();
+        __m128 peak1 = _mm_setzero_ps();
+        __m128 sum0 = _mm_setzero_ps();
+        __m128 sum1 = _mm_setzero_ps();
+
+        for (; i + 8 <= nframes; i += 8) {
+            __m128 x0 = _mm_loadu_ps(data + i);
+            __m128 x1 = _mm_loadu_ps(data + i + 4);
+            peak0 = _mm_max_ps(peak0, _mm_and_ps(x0, abs_mask));
+            peak1 = _mm_max_ps(peak1, _mm_and_ps(x1, abs_mask));
+            sum0 = _mm_add_ps(sum0, _mm_mul_ps(x0, x0));
+            sum1 = _mm_add_ps(sum1, _mm_mul_ps(x1, x1));
+        }
+
+        alignas(16) float lanes_peak[4];
+        alignas(16) float lanes_sum[4];
+        _mm_store_ps(lanes_peak, _mm_max_ps(peak0, peak1));
+        _mm_store_ps(lanes_sum, _mm_add_ps(sum0, sum1));
+        for (int lane = 0; lane < 4; ++lane) {
+            p = std::max(p, lanes_peak[lane]);
+            sum += lanes_sum[lane];
+        }
+#elif defined(TPIPE_METER_NEON)
+        float32x4_t peak0 = vdupq_n_f32(0.0f);
+        float32x4_t peak1 = vdupq_n_f32(0.0f);
+        float32x4_t sum0 = vdupq_n_f32(0.0f);
+        float32x4_t sum1 = vdupq_n_f32(0.0f);
+
+        for (; i + 8 <= nframes; i += 8) {
+            float32x4_t x0 = vld1q_f32(data + i);
+            float32x4_t x1 = vld1q_f32(data + i + 4);
+            peak0 = vmaxq_f32(peak0, vabsq_f32(x0));
+            peak1 = vmaxq_f32(peak1, vabsq_f32(x1));
+            sum0 = vmlaq_f32(sum0, x0, x0);
+            sum1 = vmlaq_f32(sum1, x1, x1);
+        }
+
+        float lanes_peak[4];
+        float lanes_sum[4];
+        vst1q_f32(lanes_peak, vmaxq_f32(peak0, peak1));
+        vst1q_f32(lanes_sum, vaddq_f32(sum0, sum1));
+        for (int lane = 0; lane < 4; ++lane) {
+            p = std::max(p, lanes_peak[lane]);
+            sum += lanes_sum[lane];
+        }
+#endif
+
+        for (; i < nframes; ++i) {
+            float x = data[i];
+            p = std::max(p, std::abs(x));
+            sum += x * x;
+        }
+
+        peak = p;
+        rms = nframes ? std::sqrt(sum / static_cast<float>(nframes)) : 0.0f;
+    }
+}
+
+namespace {
+    // A live owner holds an exclusive flock on the segment for as long as it
+    // publishes. The kernel drops the lock when the owner dies, so a segment
+    // whose lock can be taken was left behind by a crash and is removed.
+    bool remove_if_stale(const std::string& name) {
+        int fd = shm_open(name.c_str(), O_RDWR, 0);
+        if (fd < 0) return errno == ENOENT;
+
+        bool stale = flock(fd, LOCK_EX | LOCK_NB) == 0;
+        if (stale) {
+            shm_unlink(name.c_str());
+        }
+        ::close(fd);
+        return stale;
+    }
+}
+
+SignalMeter::~SignalMeter() {
+    close();
+}
+
+bool SignalMeter::open(const std::string& name) {
+    close();
+
+    // Exclusive so two instances can never share (and unlink) one seqlock
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0 && errno == EEXIST) {
+        if (!remove_if_stale(name)) {
+            std::cerr << "Meter segment '" << name << "' is in use by another "
+                      << "running tpipe instance\n";
+            return false;
+        }
+        fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    }
+    if (fd < 0) {
+        std::cerr << "Failed to create meter segment '" << name << "': "
+                  << std::strerror(errno) << "\n";
+        return false;
+    }
+
+    // Held until close(); marks the segment as owned by a live instance
+    if (flock(fd, LOCK_EX | LOCK_NB) != 0) {
+        std::cerr << "Meter segment '" << name << "' was claimed by another "
+                  << "tpipe instance\n";
+        ::close(fd);
+        return false;
+    }
+
+    if (ftruncate(fd, sizeof(MeterSegment)) != 0) {
+        std::cerr << "Failed to size meter segment: " << std::strerror(errno) << "\n";
+        ::close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    void* addr = mmap(nullptr, sizeof(MeterSegment), PROT_READ | PROT_WRITE,
+                      MAP_SHARED, fd, 0);
+
+    if (addr == MAP_FAILED) {
+        std::cerr << "Failed to map meter segment: " << std::strerror(errno) << "\n";
+        ::close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    // Touch the page now so the process thread never takes a page fault
+    std::memset(addr, 0, sizeof(MeterSegment));
+    segment_ = new (addr) MeterSegment{};
+    segment_->magic = MeterSegment::MAGIC;
+    segment_->version = MeterSegment::VERSION;
+    fd_ = fd;
+    name_ = name;
+
+    return true;
+}
+
+void SignalMeter::close() {
+    if (!segment_) return;
+
+    munmap(segment_, sizeof(MeterSegment));
+    shm_unlink(name_.c_str());
+    ::close(fd_);
+    segment_ = nullptr;
+    fd_ = -1;
+}
+
+void SignalMeter::measure(MeterChannel channel, const float* data,
+                          unsigned long nframes) {
+    measure_block(data, nframes, staging_.peak[channel], staging_.rms[channel]);
+}
+
+void SignalMeter::set_ducking(float mic_envelope, float gain_l, float gain_r) {
+    staging_.mic_envelope = mic_envelope;
+    staging_.duck_gain_l = gain_l;
+    staging_.duck_gain_r = gain_r;
+}
+
+void SignalMeter::publish(unsigned long nframes) {
+    if (!segment_) return;
+
+    staging_.nframes = static_cast<uint32_t>(nframes);
+    ++staging_.block_count;
+
+    uint32_t seq = segment_->sequence.load(std::memory_order_relaxed);
+    segment_->sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    segment_->snapshot = staging_;
+
+    segment_->sequence.store(seq + 2, std::memory_order_release);
+}
@@ -0,0 +1,186 @@
+#include "TraceRecorder.hpp"
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace {
+    // Generous upper bound on events per second per thread: ~16 events per
+    // callback at 16-frame periods and 48 kHz is 48000 events/s.
+    constexpr float EVENTS_PER_SECOND = 65536.0f;
+
+    uint64_t next_power_of_two(uint64_t value) {
+        uint64_t result = 1;
+        while (result < value) result <<= 1;
+        return result;
+    }
+
+    // Each thread remembers which ring it was assigned by which recorder.
+    // Recorders are told apart by a generation number rather than their
+    // address, which a later recorder may reuse after the first is freed
+    // (e.g. jack_unload followed by jack_load on jackd's process thread).
+    std::atomic<uint64_t> next_generation{1};
+    thread_local uint64_t tls_generation = 0;
+    thread_local void* tls_ring = nullptr;
+}
+
+TraceRecorder::TraceRecorder(float seconds, unsigned max_threads)
+    : seconds_(std::max(seconds, 0.1f)),
+      generation_(next_generation.fetch_add(1, std::memory_order_relaxed)) {
+    uint64_t capacity = next_power_of_two(
+        static_cast<uint64_t>(seconds_ * EVENTS_PER_SECOND));
+    mask_ = capacity - 1;
+
+    // Value-initialized, so every page is touched before the process thread runs
+    for (unsigned i = 0; i < max_threads; ++i) {
+        auto ring = std::make_unique<Ring>();
+        ring->records.resize(capacity);
+        rings_.push_back(std::move(ring));
+    }
+
+    base_ticks_ = read_ticks();
+    base_ns_ = steady_ns();
+}
+
+uint64_t TraceRecorder::read_ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return steady_ns();
+#endif
+}
+
+uint64_t TraceRecorder::steady_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+TraceRecorder::Ring* TraceRecorder::thread_ring() {
+    if (tls_generation == generation_) {
+        return static_cast<Ring*>(tls_ring);
+    }
+
+    unsigned slot = next_ring_.fetch_add(1, std::memory_order_relaxed);
+    tls_generation = generation_;
+    tls_ring = (slot < rings_.size()) ? rings_[slot].get() : nullptr;
+    return static_cast<Ring*>(tls_ring);
+}
+
+void TraceRecorder::record(Event event, uint8_t phase, uint32_t arg) {
+    Ring* ring = thread_ring();
+    if (!ring) return;
+
+    uint64_t head = ring->head.load(std::memory_order_relaxed);
+    ring->records[head & mask_] = Record{read_ticks(), arg,
+                                         static_cast<uint16_t>(event), phase, 0};
+    ring->head.store(head + 1, std::memory_order_release);
+}
+
+const char* TraceRecorder::event_name(uint16_t event) {
+    switch (static_cast<Event>(event)) {
+        case Event::Process:      return "process";
+        case Event::InputFilters: return "input_filters";
+        case Event::Ladspa:       return "ladspa";
+        case Event::OutputMix:    return "output_mix";
+        case Event::Fused:        return "fused";
+        case Event::Meter:        return "meter";
+        case Event::LadspaRun:    return "LadspaLoader::run";
+        case Event::BufferSize:   return "buffer_size";
+        case Event::Xrun:         return "xrun";
+        case Event::TierChange:   return "tier_change";
+        case Event::Count:        break;
+    }
+    return "unknown";
+}
+
+bool TraceRecorder::dump(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out.is_open()) return false;
+
+    uint64_t now_ticks = read_ticks();
+    uint64_t now_ns = steady_ns();
+    double ticks_per_ns = (now_ns > base_ns_ && now_ticks > base_ticks_)
+        ? static_cast<double>(now_ticks - base_ticks_) / static_cast<double>(now_ns - base_ns_)
+        : 1.0;
+
+    auto to_us = [&](uint64_t ticks) {
+        double ns = static_cast<double>(ticks - base_ticks_) / ticks_per_ns;
+        return (static_cast<double>(base_ns_) + ns) / 1000.0;
+    };
+
+    uint64_t capacity = mask_ + 1;
+    uint64_t window = static_cast<uint64_t>(seconds_ * 1e9 * ticks_per_ns);
+    uint64_t cutoff = (now_ticks > window) ? now_ticks - window : 0;
+    int pid = static_cast<int>(getpid());
+
+    out << std::fixed << std::setprecision(3);
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+
+    bool first = true;
+    auto separator = [&]() -> std::ostream& {
+        if (!first) out << ",\n";
+        first = false;
+        return out;
+    };
+
+    for (size_t tid = 0; tid < rings_.size(); ++tid) {
+        const Ring& ring = *rings_[tid];
+
+        uint64_t head = ring.head.load(std::memory_order_acquire);
+        if (head == 0) continue;
+
+        uint64_t start = (head > capacity) ? head - capacity : 0;
+        std::vector<Record> records;
+        records.reserve(head - start);
+        for (uint64_t i = start; i < head; ++i) {
+            records.push_back(ring.records[i & mask_]);
+        }
+
+        // Anything the writer lapped while we were copying is unreliable
+        uint64_t head_after = ring.head.load(std::memory_order_acquire);
+        if (head_after > capacity && head_after - capacity > start) {
+            uint64_t lapped = std::min<uint64_t>(head_after - capacity - start, records.size());
+            records.erase(records.begin(), records.begin() + lapped);
+        }
+
+        separator() << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid
+                    << ",\"tid\":" << tid << ",\"args\":{\"name\":\"tpipe thread "
+                    << tid << "\"}}";
+
+        // Pair begin/end into complete events; unmatched halves at the
+        // window edges are dropped
+        std::vector<const Record*> open;
+        for (const Record& rec : records) {
+            if (rec.ticks < cutoff) continue;
+
+            if (rec.phase == PHASE_BEGIN) {
+                open.push_back(&rec);
+            } else if (rec.phase == PHASE_END) {
+                if (open.empty() || open.back()->event != rec.event) {
+                    open.clear();
+                    continue;
+                }
+                const Record* begin = open.back();
+                open.pop_back();
+
+                separator() << "{\"name\":\"" << event_name(rec.event)
+                            << "\",\"ph\":\"X\",\"pid\":" << pid << ",\"tid\":" << tid
+                            << ",\"ts\":" << to_us(begin->ticks)
+                            << ",\"dur\":" << (to_us(rec.ticks) - to_us(begin->ticks)) << "}";
+            } else {
+                separator() << "{\"name\":\"" << event_name(rec.event)
+                            << "\",\"ph\":\"i\",\"s\":\"t\",\"pid\":" << pid
+                            << ",\"tid\":" << tid << ",\"ts\":" << to_us(rec.ticks)
+                            << ",\"args\":{\"value\":" << rec.arg << "}}";
+            }
+        }
+    }
+
+    out << "\n]}\n";
+    return out.good();
+}
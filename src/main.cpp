@@ -8,23 +8,30 @@
 #include <string>
 #include <vector>
 #include <filesystem>
+#include <unistd.h>
 
 
-#ifndef DEFAULT_CONFIG_PATH
-#define DEFAULT_CONFIG_PATH "/etc/tpipe/default.conf"
-#endif
-
 namespace {
+    // Default used before the path was derived from the install prefix;
+    // still honoured so existing setups keep working
+    constexpr const char* LEGACY_CONFIG_PATH = "/etc/tpipe/default.conf";
+    
     std::atomic<bool> keep_running{true};
+    std::atomic<bool> dump_trace{false};
     
     void signal_handler(int signal) {
         std::cout << "\n[Interrupt signal (" << signal << ") received]. Cleaning up...\n";
         keep_running = false;
     }
     
+    void dump_trace_handler(int) {
+        dump_trace = true;
+    }
+    
     void setup_signal_handlers() {
         std::signal(SIGINT, signal_handler);
         std::signal(SIGTERM, signal_handler);
+        std::signal(SIGUSR1, dump_trace_handler);
     }
 }
 
@@ -38,6 +45,7 @@ void print_usage(const char* bin_name) {
 
 int main(int argc, char* argv[]) {
     std::string config_file = DEFAULT_CONFIG_PATH;
+    bool config_given = false;
     std::vector<std::string> args(argv + 1, argv + argc);
 
     for (size_t i = 0; i < args.size(); ++i) {
@@ -47,6 +55,7 @@ int main(int argc, char* argv[]) {
         } else if (args[i] == "-c" || args[i] == "--config") {
             if (i + 1 < args.size()) {
                 config_file = args[++i];
+                config_given = true;
             } else {
                 std::cerr << "Error: -c requires a file path.\n";
                 return 1;
@@ -54,6 +63,11 @@ int main(int argc, char* argv[]) {
         }
     }
 
+    if (!config_given && !std::filesystem::exists(config_file)
+        && std::filesystem::exists(LEGACY_CONFIG_PATH)) {
+        config_file = LEGACY_CONFIG_PATH;
+    }
+
     if (!std::filesystem::exists(config_file)) {
         std::cerr << "Error: Configuration file not found: " << config_file << "\n";
         return 1;
@@ -79,7 +93,16 @@ int main(int argc, char* argv[]) {
     
     setup_signal_handlers();
     
+    if (engine.is_tracing()) {
+        std::cout << "Send SIGUSR1 (kill -USR1 " << getpid()
+                  << ") to dump the current trace.\n";
+    }
+    
     while (keep_running) {
+        if (dump_trace.exchange(false)) {
+            engine.request_trace_dump();
+        }
+        engine.poll();
         std::this_thread::sleep_for(std::chrono::milliseconds(50));
     }
     